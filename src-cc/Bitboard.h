@@ -0,0 +1,69 @@
+#ifndef Bitboard_h_
+#define Bitboard_h_
+
+#include <cinttypes>
+
+#include "Board.h"
+
+// Shift-and-mask helpers over the bitboards returned by Board::Stones().
+// Each column occupies kHeight + 1 bits so that shifts by a whole column,
+// or a column plus/minus one row, never wrap a line into its neighbour.
+struct Bitboard {
+  static constexpr int kColumnBits = Board::kHeight + 1;
+
+  static constexpr uint64_t kBottomRow = [] {
+    uint64_t mask = 0;
+    for (int col = 0; col < Board::kWidth; ++col) {
+      mask |= uint64_t{1} << (col * kColumnBits);
+    }
+    return mask;
+  }();
+  static constexpr uint64_t kCells = kBottomRow * ((1u << Board::kHeight) - 1);
+
+  static constexpr uint64_t Column(int col) {
+    return uint64_t{(1u << Board::kHeight) - 1} << (col * kColumnBits);
+  }
+  static constexpr uint64_t Row(int row) {
+    return kBottomRow << row;
+  }
+
+  // Empty cells that would complete four in a line for `stones`, whether or
+  // not they can be played yet.
+  static constexpr uint64_t WinningCells(uint64_t stones) {
+    // Vertical: three stones directly below.
+    uint64_t result = (stones << 1) & (stones << 2) & (stones << 3);
+    // Horizontal and both diagonals: three stones on either side of, or
+    // straddling, the cell.
+    for (int shift : {kColumnBits, kColumnBits - 1, kColumnBits + 1}) {
+      uint64_t pair = (stones << shift) & (stones << 2 * shift);
+      result |= pair & (stones << 3 * shift);
+      result |= pair & (stones >> shift);
+      pair = (stones >> shift) & (stones >> 2 * shift);
+      result |= pair & (stones << shift);
+      result |= pair & (stones >> 3 * shift);
+    }
+    return result & kCells;
+  }
+
+  // Whether `stones` already hold four in a line.
+  static constexpr bool HasFour(uint64_t stones) {
+    for (int shift : {1, kColumnBits, kColumnBits - 1, kColumnBits + 1}) {
+      uint64_t pairs = stones & (stones >> shift);
+      if (pairs & (pairs >> 2 * shift)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The lowest empty cell of every column that is not full.
+  static constexpr uint64_t PlayableCells(uint64_t occupied) {
+    return (occupied + kBottomRow) & kCells;
+  }
+
+  static int Count(uint64_t bits) {
+    return __builtin_popcountll(bits);
+  }
+};
+
+#endif
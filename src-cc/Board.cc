@@ -93,7 +93,8 @@ class Slice {
         return bitmap_[index];
       };
       auto MaskBits = [&](int offset) -> unsigned char {
-        return mask_ >> offset * direction.second;
+        int shift = offset * direction.second;
+        return shift >= 0 ? mask_ >> shift : mask_ << -shift;
       };
       int length = 1;
       for (int i = 1; BoardBits(i) & MaskBits(i); ++i) ++length;
@@ -201,3 +202,18 @@ class BoardImpl : public Board {
 std::unique_ptr<Board> Board::New(uint64_t position) {
   return std::unique_ptr<Board>(new BoardImpl(position));
 }
+
+uint64_t Board::Play(uint64_t position, bool player, int column) {
+  BoardData data(position);
+  data[column].push_back(player);
+  return data.Encode();
+}
+
+uint64_t Board::Stones(uint64_t position, bool player) {
+  auto bitmap = BoardData(position).GetBitmap(player);
+  uint64_t stones = 0;
+  for (int i = 0; i < kWidth; ++i) {
+    stones |= uint64_t{bitmap[i]} << (i * (kHeight + 1));
+  }
+  return stones;
+}
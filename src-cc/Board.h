@@ -13,6 +13,15 @@ class Board {
     static constexpr int kHeight = 6;
 
     static std::unique_ptr<Board> New(uint64_t position = 0);
+
+    // The stones `player` has in an encoded position, as a bitboard with
+    // cell (column, row) at bit column * (kHeight + 1) + row. The spare top
+    // bit of each column is always clear; see Bitboard.h.
+    static uint64_t Stones(uint64_t position, bool player);
+
+    // The encoded position after `player` drops a stone in `column`, which
+    // must be a valid move. Unlike PlayStone this does not test for a win.
+    static uint64_t Play(uint64_t position, bool player, int column);
     std::unique_ptr<Board> Clone() const {
       return New(Encode());
     }
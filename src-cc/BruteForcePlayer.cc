@@ -7,6 +7,8 @@
 #include <string>
 #include <string_view>
 #include "Board.h"
+#include "Evaluator.h"
+#include "PositionCache.h"
 
 namespace {
   template<typename T1, typename T2> void EnsureValueInRange(std::string name, T2 min, T1 value, T2 max) {
@@ -26,23 +28,37 @@ class BruteForcePlayer : public Player {
   int kMaxDepth;
   double kSharpness;
   double kDiscount;
+  double kEvalScale;
 
   void StartGame(const Board* board, bool player_id) override {
     player_id_ = player_id;
     board_ = board;
+    rand_.seed(set_seed((*rd_)()));
   }
 
-  std::vector<double> GetPolicy(const Board* board, bool player, int depth) {
-    std::vector<double> weights(board->kWidth);
-    for (int move : board->ValidMoves()) {
-      auto tmp = board->Clone();
-      if (tmp->PlayStone(player, move)) {
+  std::vector<double> GetPolicy(uint64_t position, bool player, int depth) {
+    std::vector<double> weights(Board::kWidth);
+    auto entry = PositionCache::Global().Get(position);
+    for (int move = 0; move < Board::kWidth; ++move) {
+      if (!(entry.valid_moves & (1u << move))) {
+        continue;
+      }
+      ++nodes_;
+      if (entry.IsWinningMove(player, move)) {
         weights[move] = kSharpness;
-      } else if (depth <= 0) {
-        weights[move] = 0.5;
+        continue;
+      }
+      uint64_t child = Board::Play(position, player, move);
+      if (depth <= 0) {
+        weights[move] = std::clamp(
+            Evaluate(child, player, kEvalScale),
+            1 - kSharpness, kSharpness);
+      } else if (entry.outcome[player] == PositionCache::kLoss) {
+        // Facing two threats: the opponent wins whatever we play, which is
+        // what the recursion would conclude.
+        weights[move] = 1 - kSharpness * kDiscount;
       } else {
-        std::vector<double> w =
-          GetPolicy(tmp.get(), !player, depth - 1);
+        std::vector<double> w = GetPolicy(child, !player, depth - 1);
         double worst_case = *std::max_element(w.begin(), w.end());
         weights[move] = 1 - (worst_case * kDiscount);
       }
@@ -51,36 +67,83 @@ class BruteForcePlayer : public Player {
   }
 
   int GetMove() override {
+    return ChooseMove(/*sample=*/true);
+  }
+
+  int GetBestMove() override {
+    return ChooseMove(/*sample=*/false);
+  }
+
+  // Samples a move in proportion to its weight, or takes the heaviest one
+  // (the lowest column on ties).
+  int ChooseMove(bool sample) {
+    nodes_ = 0;
     std::vector<double> weights =
-      GetPolicy(board_, player_id_, kMaxDepth);
-    for (unsigned int i = 0 ; i < weights.size(); i++) {
-      std::cout << (i+1) << " = " << weights[i] << "\n";
+      GetPolicy(board_->Encode(), player_id_, kMaxDepth);
+    if (verbose()) {
+      for (unsigned int i = 0 ; i < weights.size(); i++) {
+        std::cout << (i+1) << " = " << weights[i] << "\n";
+      }
+    }
+    int selection;
+    if (sample) {
+      // Evaluator leaves can leave a forced block weighing little more than
+      // the moves that lose outright, so never sample a move that allows an
+      // immediate win while some other move does not.
+      const double loss_weight = 1 - kSharpness * kDiscount;
+      if (*std::max_element(weights.begin(), weights.end()) > loss_weight) {
+        for (auto& weight : weights) {
+          if (weight <= loss_weight) {
+            weight = 0;
+          }
+        }
+      }
+      std::discrete_distribution<int> dist(weights.begin(), weights.end());
+      selection = dist(rand_);
+    } else {
+      selection = std::max_element(weights.begin(), weights.end()) -
+        weights.begin();
     }
-    std::discrete_distribution<int> dist(weights.begin(), weights.end());
-    int selection = dist(rand_);
-    std::cout << *this << " Plays " << (selection + 1) << "\n\n";
+    if (verbose()) {
+      std::cout << *this << " Plays " << (selection + 1)
+        << " (" << nodes_ << " nodes)\n\n";
+    }
+    last_move_stats_ = {nodes_, static_cast<float>(weights[selection])};
     return selection;
   }
 
+  std::optional<MoveStats> last_move_stats() const override {
+    return last_move_stats_;
+  }
+
   const Board* board_;
   bool player_id_;
+  std::unique_ptr<std::random_device> rd_;
   std::mt19937 rand_;
+  uint32_t nodes_ = 0;
+  MoveStats last_move_stats_;
 
   public:
   BruteForcePlayer(std::string_view name,
-      int depth, double sharpness, double discount,
+      int depth, double sharpness, double discount, double eval_scale,
       std::unique_ptr<std::random_device> rd)
     : Player(name),
-      kMaxDepth(depth), kSharpness(sharpness), kDiscount(discount), rand_((*rd)())
+      kMaxDepth(depth), kSharpness(sharpness), kDiscount(discount),
+      kEvalScale(eval_scale), rd_(std::move(rd)), rand_(set_seed((*rd_)()))
        {
         EnsureValueInRange("depth", 0, depth, 10);
         EnsureValueInRange("sharpness", 0.0, sharpness, 1.0);
         EnsureValueInRange("discount", 0.0, discount, 1.0);
+        if (eval_scale < 0.0 || eval_scale >= 100.0) {
+          throw std::range_error(
+              "Invalid Value [eval_scale=" + std::to_string(eval_scale) +
+              "]: NOT 0 <= eval_scale < 100");
+        }
       }
 };
 
 std::unique_ptr<Player> Player::NewBruteForce(std::string_view name,
-    int depth, double sharpness, double discount,
+    int depth, double sharpness, double discount, double eval_scale,
     std::unique_ptr<std::random_device> rd) {
-  return std::unique_ptr<Player>{new BruteForcePlayer(name, depth, sharpness, discount, std::move(rd))};
+  return std::unique_ptr<Player>{new BruteForcePlayer(name, depth, sharpness, discount, eval_scale, std::move(rd))};
 }
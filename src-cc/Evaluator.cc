@@ -0,0 +1,62 @@
+#include "Evaluator.h"
+
+#include <cmath>
+
+#include "Bitboard.h"
+#include "Board.h"
+
+namespace {
+  constexpr double kImmediateWeight = 4.0;
+  constexpr double kThreatWeight = 0.5;
+  constexpr double kParityWeight = 0.5;
+  constexpr double kCenterWeight = 0.1;
+
+  // Zugzwang favours the first player's threats on odd rows (counting from
+  // one) and the second player's on even rows.
+  constexpr uint64_t kOddRows =
+    Bitboard::Row(0) | Bitboard::Row(2) | Bitboard::Row(4);
+  constexpr uint64_t kEvenRows =
+    Bitboard::Row(1) | Bitboard::Row(3) | Bitboard::Row(5);
+
+  int CenterControl(uint64_t stones) {
+    constexpr int kCenter = Board::kWidth / 2;
+    int score = 0;
+    for (int col = 0; col < Board::kWidth; ++col) {
+      int distance = col < kCenter ? kCenter - col : col - kCenter;
+      score += (kCenter - distance) *
+        Bitboard::Count(stones & Bitboard::Column(col));
+    }
+    return score;
+  }
+}
+
+double Evaluate(uint64_t position, bool player, double scale) {
+  uint64_t mine = Board::Stones(position, player);
+  uint64_t theirs = Board::Stones(position, !player);
+  uint64_t empty = Bitboard::kCells & ~(mine | theirs);
+  uint64_t playable = Bitboard::PlayableCells(mine | theirs);
+
+  uint64_t my_threats = Bitboard::WinningCells(mine) & empty;
+  uint64_t their_threats = Bitboard::WinningCells(theirs) & empty;
+
+  double score = 0;
+  // The opponent is to move: any playable threat of theirs wins, while two
+  // of ours cannot both be blocked.
+  if (their_threats & playable) {
+    score -= kImmediateWeight;
+  } else if (Bitboard::Count(my_threats & playable) >= 2) {
+    score += kImmediateWeight;
+  }
+
+  score += kThreatWeight *
+    (Bitboard::Count(my_threats) - Bitboard::Count(their_threats));
+
+  uint64_t my_rows = player ? kOddRows : kEvenRows;
+  uint64_t their_rows = player ? kEvenRows : kOddRows;
+  score += kParityWeight * (Bitboard::Count(my_threats & my_rows) -
+                            Bitboard::Count(their_threats & their_rows));
+
+  score += kCenterWeight * (CenterControl(mine) - CenterControl(theirs));
+
+  return 1 / (1 + std::exp(-scale * score));
+}
@@ -0,0 +1,14 @@
+#ifndef Evaluator_h_
+#define Evaluator_h_
+
+#include <cinttypes>
+
+// Static evaluation of an encoded position from `player`'s point of view,
+// assuming it is the other player's turn (i.e. `player` just moved). Player
+// `true` is taken to have moved first, which decides threat parity.
+//
+// Returns an estimated win probability in (0, 1); `scale` controls how far
+// the positional features push it away from 0.5, and 0 always yields 0.5.
+double Evaluate(uint64_t position, bool player, double scale);
+
+#endif
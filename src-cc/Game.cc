@@ -1,5 +1,7 @@
 #include "Game.h"
 
+#include "GameRecord.h"
+
 Game::Game(Player* p1, Player* p2) :
   players_{p1, p2}, board_(Board::New()) {
 }
@@ -17,14 +19,43 @@ Player* Game::Play() const {
   players_[0]->StartGame(board_.get(), true);
   players_[1]->StartGame(board_.get(), false);
 
+  GameRecord record;
+  for (int i = 0; i < 2; i++) {
+    record.specs[i] = players_[i]->spec();
+    record.seeds[i] = players_[i]->seed();
+  }
+  auto finish = [&](GameRecord::Result result) {
+    if (recorder_ == nullptr) {
+      return;
+    }
+    record.result = result;
+    // Stats are all-or-nothing per record; drop them if either player
+    // (e.g. a human) had none to report.
+    if (record.stats.size() != record.moves.size()) {
+      record.stats.clear();
+    }
+    recorder_->Write(record);
+  };
+
   while (!board_->ValidMoves().empty()) {
     Player *player = players_[player_to_move];
-    std::cout << *this << "\n\n";
-    if (board_->PlayStone(player_to_move == 0, player->GetMove())) {
+    if (verbose_) {
+      std::cout << *this << "\n\n";
+    }
+    int move = player->GetMove();
+    bool won = board_->PlayStone(player_to_move == 0, move);
+    record.moves.push_back(move);
+    if (auto stats = player->last_move_stats()) {
+      record.stats.push_back(*stats);
+    }
+    if (won) {
+      finish(player_to_move == 0 ? GameRecord::kFirstPlayerWins
+                                 : GameRecord::kSecondPlayerWins);
       return player;
     }
     player_to_move = 1 - player_to_move;
   }
+  finish(GameRecord::kDraw);
   return nullptr;
 }
 
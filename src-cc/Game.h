@@ -6,15 +6,23 @@
 #include "Board.h"
 #include "Player.h"
 
+class GameRecordWriter;
+
 class Game {
   public:
     Game(Player* p1, Player* p2);
     void Dump(std::ostream& os) const;
     Player* Play() const;
 
+    // When set, every finished game is appended to `recorder`.
+    void set_recorder(GameRecordWriter* recorder) { recorder_ = recorder; }
+    void set_verbose(bool verbose) { verbose_ = verbose; }
+
   private:
     Player* players_[2];
     std::unique_ptr<Board> board_;
+    GameRecordWriter* recorder_ = nullptr;
+    bool verbose_ = true;
 };
 
 inline std::ostream& operator << (std::ostream& os, const Game& game) {
@@ -0,0 +1,195 @@
+#include "GameRecord.h"
+
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Board.h"
+
+namespace {
+  constexpr size_t kStatsSize = sizeof(uint32_t) + sizeof(float);
+
+  void Append(std::vector<char>& buffer, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + size);
+  }
+}
+
+std::unique_ptr<GameRecordWriter> GameRecordWriter::Open(
+    const std::string& path) {
+  int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) {
+    return {};
+  }
+  return std::unique_ptr<GameRecordWriter>{new GameRecordWriter(fd)};
+}
+
+GameRecordWriter::~GameRecordWriter() {
+  try {
+    Flush();
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+  }
+  close(fd_);
+}
+
+void GameRecordWriter::Flush() {
+  if (buffer_.empty()) {
+    return;
+  }
+  ssize_t written = write(fd_, buffer_.data(), buffer_.size());
+  size_t size = buffer_.size();
+  buffer_.clear();
+  if (written < 0 || static_cast<size_t>(written) != size) {
+    throw std::runtime_error("failed writing game records");
+  }
+}
+
+void GameRecordWriter::Write(const GameRecord& record) {
+  for (const auto& spec : record.specs) {
+    if (spec.size() > 255) {
+      throw std::length_error("player spec too long: " + spec);
+    }
+  }
+  if (record.moves.size() > 255) {
+    throw std::length_error("too many moves in game record");
+  }
+  bool has_stats = !record.stats.empty();
+  if (has_stats && record.stats.size() != record.moves.size()) {
+    throw std::invalid_argument("game record stats do not match moves");
+  }
+
+  GameRecord::Header header{};
+  header.magic = GameRecord::kMagic;
+  header.size = sizeof(header) + record.specs[0].size() +
+    record.specs[1].size() + record.moves.size() +
+    (has_stats ? record.stats.size() * kStatsSize : 0);
+  header.flags = has_stats ? GameRecord::kHasStats : 0;
+  header.result = record.result;
+  header.seeds[0] = record.seeds[0];
+  header.seeds[1] = record.seeds[1];
+  header.num_moves = record.moves.size();
+  header.spec_length[0] = record.specs[0].size();
+  header.spec_length[1] = record.specs[1].size();
+
+  Append(buffer_, &header, sizeof(header));
+  Append(buffer_, record.specs[0].data(), record.specs[0].size());
+  Append(buffer_, record.specs[1].data(), record.specs[1].size());
+  Append(buffer_, record.moves.data(), record.moves.size());
+  for (const auto& stats : record.stats) {
+    Append(buffer_, &stats.visits, sizeof(stats.visits));
+    Append(buffer_, &stats.value, sizeof(stats.value));
+  }
+
+  if (buffer_.size() >= kFlushThreshold) {
+    Flush();
+  }
+}
+
+std::string_view GameRecordView::spec(int player) const {
+  const char* specs = data_ + sizeof(GameRecord::Header);
+  size_t offset = player == 0 ? 0 : header().spec_length[0];
+  return {specs + offset, header().spec_length[player]};
+}
+
+std::span<const uint8_t> GameRecordView::moves() const {
+  const char* moves = data_ + sizeof(GameRecord::Header) +
+    header().spec_length[0] + header().spec_length[1];
+  return {reinterpret_cast<const uint8_t*>(moves), header().num_moves};
+}
+
+Player::MoveStats GameRecordView::stats(int ply) const {
+  Player::MoveStats result;
+  if (!has_stats()) {
+    return result;
+  }
+  auto moves = this->moves();
+  const char* stats = reinterpret_cast<const char*>(moves.data()) +
+    moves.size() + ply * kStatsSize;
+  std::memcpy(&result.visits, stats, sizeof(result.visits));
+  std::memcpy(&result.value, stats + sizeof(result.visits),
+      sizeof(result.value));
+  return result;
+}
+
+void GameRecordReader::Iterator::Validate() {
+  if (pos_ == end_) {
+    return;
+  }
+  GameRecord::Header header;
+  if (static_cast<size_t>(end_ - pos_) < sizeof(header)) {
+    pos_ = end_;
+    return;
+  }
+  std::memcpy(&header, pos_, sizeof(header));
+  size_t expected = sizeof(header) + header.spec_length[0] +
+    header.spec_length[1] + header.num_moves +
+    ((header.flags & GameRecord::kHasStats) ? header.num_moves * kStatsSize : 0);
+  if (header.magic != GameRecord::kMagic || header.size != expected ||
+      static_cast<size_t>(end_ - pos_) < expected) {
+    pos_ = end_;
+    return;
+  }
+  const char* moves = pos_ + sizeof(header) + header.spec_length[0] +
+    header.spec_length[1];
+  for (int i = 0; i < header.num_moves; i++) {
+    if (static_cast<uint8_t>(moves[i]) >= Board::kWidth) {
+      pos_ = end_;
+      return;
+    }
+  }
+}
+
+GameRecordReader::Iterator& GameRecordReader::Iterator::operator++() {
+  GameRecord::Header header;
+  std::memcpy(&header, pos_, sizeof(header));
+  pos_ += header.size;
+  Validate();
+  return *this;
+}
+
+std::unique_ptr<GameRecordReader> GameRecordReader::Open(
+    const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return {};
+  }
+  size_t size = st.st_size;
+  const char* data = nullptr;
+  if (size > 0) {
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      close(fd);
+      return {};
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapped);
+  }
+  close(fd);
+  return std::unique_ptr<GameRecordReader>{new GameRecordReader(data, size)};
+}
+
+GameRecordReader::~GameRecordReader() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+size_t GameRecordReader::valid_size() const {
+  const char* last = data_;
+  for (GameRecordView record : *this) {
+    last = record.data() + record.size();
+  }
+  return last - data_;
+}
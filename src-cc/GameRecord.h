@@ -0,0 +1,153 @@
+#ifndef GameRecord_h_
+#define GameRecord_h_
+
+#include <cinttypes>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Player.h"
+
+// Binary game records. A record file is a plain concatenation of records,
+// so files can be appended to by concurrent runs and joined with cat.
+// Each record is:
+//
+//   Header                       20 bytes, see below
+//   player specs                 spec_length[0] + spec_length[1] bytes
+//   moves                        num_moves bytes, one column (0-6) per ply
+//   MoveStats (kHasStats only)   num_moves * 8 bytes: uint32 visits, float value
+//
+// All integers are stored in host byte order.
+struct GameRecord {
+  static constexpr uint32_t kMagic = 0x31473443;  // "C4G1"
+
+  enum Result : uint8_t { kDraw = 0, kFirstPlayerWins = 1, kSecondPlayerWins = 2 };
+  enum Flags : uint8_t { kHasStats = 1 };
+
+  struct Header {
+    uint32_t magic;
+    uint16_t size;  // Total record size including this header.
+    uint8_t flags;
+    uint8_t result;
+    uint32_t seeds[2];
+    uint8_t num_moves;
+    uint8_t spec_length[2];
+    uint8_t reserved;
+  };
+  static_assert(sizeof(Header) == 20);
+
+  std::string specs[2];
+  uint32_t seeds[2] = {0, 0};
+  Result result = kDraw;
+  std::vector<uint8_t> moves;
+  std::vector<Player::MoveStats> stats;  // Empty, or one entry per move.
+};
+
+class GameRecordWriter {
+  public:
+    // Opens `path` for appending; returns nullptr if it cannot be opened.
+    static std::unique_ptr<GameRecordWriter> Open(const std::string& path);
+    ~GameRecordWriter();
+
+    // Records are buffered and written whole, so concurrent appenders to the
+    // same file never interleave within a record.
+    void Write(const GameRecord& record);
+    void Flush();
+
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+
+  private:
+    static constexpr size_t kFlushThreshold = 64 * 1024;
+
+    explicit GameRecordWriter(int fd) : fd_(fd) {}
+
+    int fd_;
+    std::vector<char> buffer_;
+};
+
+// Zero-copy view of one record inside a mapped file.
+class GameRecordView {
+  public:
+    explicit GameRecordView(const char* data) : data_(data) {}
+
+    // Records are packed back to back, so the header is copied out rather
+    // than referenced at a possibly unaligned address.
+    GameRecord::Header header() const {
+      GameRecord::Header header;
+      std::memcpy(&header, data_, sizeof(header));
+      return header;
+    }
+    const char* data() const { return data_; }
+    size_t size() const { return header().size; }
+    GameRecord::Result result() const {
+      return static_cast<GameRecord::Result>(header().result);
+    }
+    uint32_t seed(int player) const { return header().seeds[player]; }
+    std::string_view spec(int player) const;
+    std::span<const uint8_t> moves() const;
+    bool has_stats() const { return header().flags & GameRecord::kHasStats; }
+    Player::MoveStats stats(int ply) const;
+
+  private:
+    const char* data_;
+};
+
+class GameRecordReader {
+  public:
+    // Maps `path` read-only; returns nullptr if it cannot be mapped.
+    static std::unique_ptr<GameRecordReader> Open(const std::string& path);
+    ~GameRecordReader();
+
+    class Iterator {
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = GameRecordView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = GameRecordView;
+
+        Iterator() = default;
+        Iterator(const char* pos, const char* end) : pos_(pos), end_(end) {
+          Validate();
+        }
+
+        GameRecordView operator*() const { return GameRecordView(pos_); }
+        Iterator& operator++();
+        Iterator operator++(int) { Iterator tmp = *this; ++*this; return tmp; }
+        bool operator==(const Iterator& other) const {
+          return pos_ == other.pos_;
+        }
+
+      private:
+        // Stops iteration (pos_ = end_) at a truncated or corrupt record.
+        void Validate();
+
+        const char* pos_ = nullptr;
+        const char* end_ = nullptr;
+    };
+
+    Iterator begin() const { return Iterator(data_, data_ + size_); }
+    Iterator end() const { return Iterator(data_ + size_, data_ + size_); }
+
+    // Bytes covered by well-formed records; less than size() if the file
+    // ends in a truncated or corrupt record.
+    size_t valid_size() const;
+    size_t size() const { return size_; }
+
+    GameRecordReader(const GameRecordReader&) = delete;
+    GameRecordReader& operator=(const GameRecordReader&) = delete;
+
+  private:
+    GameRecordReader(const char* data, size_t size)
+      : data_(data), size_(size) {}
+
+    const char* data_;
+    size_t size_;
+};
+
+#endif
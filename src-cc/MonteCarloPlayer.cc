@@ -12,22 +12,38 @@
 #include <vector>
 
 #include "Board.h"
+#include "PositionCache.h"
+#include "SearchTelemetry.h"
+#include "TreeSnapshot.h"
 
 class MonteCarloPlayer : public Player {
   public:
     const int kNumRollouts;
     const double kExplorationParameter;
+    // When set, the tree is seeded from and saved back to this snapshot.
+    const std::string kSnapshotPath;
+    const int kSnapshotMinVisits;
 
     void StartGame(const Board* board, bool player_id) override {
+      if (!kSnapshotPath.empty()) {
+        AccumulateTree();
+        // Bound memory, and what a crash loses, on long runs; re-open so
+        // later seeds include what was just saved.
+        if (unsaved_.size() >= kMaxUnsavedNodes) {
+          SaveSnapshot();
+          snapshot_ = TreeSnapshot::Open(kSnapshotPath);
+        }
+      }
       board_ = board;
       player_id_ = player_id;
+      rand_.seed(set_seed((*rd_)()));
       tree_.clear();
     }
 
     struct Node {
-      int visits = 0;
+      int64_t visits = 0;
       bool is_terminal;
-      float reward = 0;
+      double reward = 0;
       std::vector<uint64_t> next;
     };
 
@@ -38,13 +54,14 @@ class MonteCarloPlayer : public Player {
       bool is_opponent_;
       Node& node_;
       const Turn* parent_ = nullptr;
+      int depth_ = 0;
 
       Turn(MonteCarloPlayer* player) :
         player_(player),
         board_state_(player->board_->Encode()),
         turn_player_id_(player->player_id_),
         is_opponent_(false),
-        node_(player_->tree_[board_state_])
+        node_(player_->GetNode(board_state_))
       {}
 
       Turn(const Turn* parent, uint64_t board_state) :
@@ -52,8 +69,9 @@ class MonteCarloPlayer : public Player {
         board_state_(board_state),
         turn_player_id_(!parent->turn_player_id_),
         is_opponent_(!parent->is_opponent_),
-        node_(player_->tree_[board_state]),
-        parent_(parent)
+        node_(player_->GetNode(board_state)),
+        parent_(parent),
+        depth_(parent->depth_ + 1)
       {}
 
       std::vector<Turn> NextTurns() const {
@@ -84,6 +102,16 @@ class MonteCarloPlayer : public Player {
         return node_.visits;
       }
 
+      // Index of the child with the most visits, the first one on ties.
+      int MostVisitedIndex() const {
+        auto next_turns = NextTurns();
+        auto best = std::max_element(next_turns.begin(), next_turns.end(),
+            [](const Turn& a, const Turn& b) {
+              return a.node_.visits < b.node_.visits;
+            });
+        return best - next_turns.begin();
+      }
+
       int SelectNodeIndex(decltype(&Turn::CalculateUct) score_fn) const {
         auto next_turns = NextTurns();
         if (next_turns.empty()) {
@@ -110,17 +138,18 @@ class MonteCarloPlayer : public Player {
         if (node_.is_terminal) {
           return;
         }
-        auto board = Board::New(board_state_);
-        auto valid_moves = board->ValidMoves();
-        if (valid_moves.empty()) {
+        auto entry = PositionCache::Global().Get(board_state_);
+        if (entry.valid_moves == 0) {
           node_.is_terminal = true;
           node_.reward = 0.5;
           return;
         }
-        for (int move : valid_moves) {
-          auto [is_terminal, child_key] = board->PlayHypothetical(
-              turn_player_id_, move);
-          if (is_terminal) {
+        for (int move = 0; move < Board::kWidth; ++move) {
+          if (!(entry.valid_moves & (1u << move))) {
+            continue;
+          }
+          uint64_t child_key = Board::Play(board_state_, turn_player_id_, move);
+          if (entry.IsWinningMove(turn_player_id_, move)) {
             Turn next_turn(this, child_key);
             Node& child = next_turn.node_;
             child.reward = is_opponent_ ? 0 : 1;
@@ -131,20 +160,32 @@ class MonteCarloPlayer : public Player {
       }
 
       float Mcts() {
-        if (node_.visits == 0) {
+        SearchTelemetry& telemetry = player_->telemetry_;
+        // Nodes seeded from a snapshot arrive with visits but no children.
+        if (node_.next.empty() && !node_.is_terminal) {
+          auto timer = telemetry.Time(SearchTelemetry::kExpand);
           Expand();
         }
 
         ++node_.visits;
 
         if (node_.is_terminal) {
+          telemetry.NoteDepth(depth_);
           return node_.reward;
         }
 
-        int selected = SelectNodeIndex(&Turn::CalculateUct);
-        Turn next_turn = NextTurns()[selected];
-        float result = node_.visits == 1 ? next_turn.RandomPlayout()
-                                         : next_turn.Mcts();
+        Turn next_turn = [&] {
+          auto timer = telemetry.Time(SearchTelemetry::kSelect);
+          return NextTurns()[SelectNodeIndex(&Turn::CalculateUct)];
+        }();
+        float result;
+        if (node_.visits == 1) {
+          telemetry.NoteDepth(next_turn.depth_);
+          auto timer = telemetry.Time(SearchTelemetry::kPlayout);
+          result = next_turn.RandomPlayout();
+        } else {
+          result = next_turn.Mcts();
+        }
         node_.reward += result;
         return result;
       }
@@ -167,6 +208,16 @@ class MonteCarloPlayer : public Player {
     };
 
     int GetMove() override {
+      return Search(/*sample=*/true);
+    }
+
+    int GetBestMove() override {
+      return Search(/*sample=*/false);
+    }
+
+    // Runs kNumRollouts rollouts from the current position, then picks a
+    // most-visited child, at random among ties when sampling.
+    int Search(bool sample) {
       auto valid_moves = board_->ValidMoves();
 
       if (valid_moves.empty()) {
@@ -175,58 +226,189 @@ class MonteCarloPlayer : public Player {
 
       Turn turn(this);
 
+      telemetry_.BeginMove();
       for (int i = 0; i < kNumRollouts; ++i) {
-        turn.Mcts();
+        if (telemetry_.active()) {
+          auto start = SearchTelemetry::Clock::now();
+          turn.Mcts();
+          telemetry_.AddRollout(SearchTelemetry::Clock::now() - start);
+        } else {
+          turn.Mcts();
+        }
       }
 
-      const Node& root = turn.node_;
-      std::cout << "Root visits: " << root.visits
-        << ", tree_size=" << tree_.size()
-        << '\n';
-      int i = 0;
-      for (const auto& next_turn : turn.NextTurns()) {
-        std::cout << "utc[" << (valid_moves[i++]+1) << "] = "
-          << next_turn.CalculateUct()
-          << " - " << next_turn.node_.reward << "/" << next_turn.node_.visits
-          << " terminal=" << next_turn.node_.is_terminal
-          << '\n';
-
-          int j = 0;
-          for (const auto& next_next_turn : next_turn.NextTurns()) {
-            const Node& m = next_next_turn.node_;
-            std::cout << "... utc[" << (valid_moves[j++]+1) << "] = "
-              << next_next_turn.CalculateUct()
-              << " - " << m.reward << "/" << m.visits
-              << " terminal=" << m.is_terminal
-              << '\n';
-          }
+      int move = valid_moves[sample
+        ? turn.SelectNodeIndex(&Turn::CalculateRootScore)
+        : turn.MostVisitedIndex()];
+      if (telemetry_.active()) {
+        EmitTelemetry(turn, valid_moves, move);
+      }
+      RecordMoveStats(turn, valid_moves, move);
+      if (verbose()) {
+        std::cout << "\n" << name() << " plays " << (move+1) << '\n';
       }
-
-      int move = valid_moves[turn.SelectNodeIndex(&Turn::CalculateRootScore)];
-      std::cout << "\n" << name() << " plays " << (move+1) << '\n';
       return move;
     }
 
+    std::optional<MoveStats> last_move_stats() const override {
+      return last_move_stats_;
+    }
+
   private:
+    // Nodes held in unsaved_ before StartGame saves them.
+    static constexpr size_t kMaxUnsavedNodes = 1 << 16;
+
+    Node& GetNode(uint64_t key) {
+      auto [it, inserted] = tree_.try_emplace(key);
+      if (inserted && !kSnapshotPath.empty()) {
+        auto [visits, reward] = Seed(key);
+        it->second.visits = visits;
+        it->second.reward = ToPerspective(visits, reward);
+      }
+      return it->second;
+    }
+
+    // Visits and reward, from player `true`'s point of view, that a node
+    // starts a game with: the snapshot on disk plus earlier, unsaved games.
+    std::pair<int64_t, double> Seed(uint64_t key) const {
+      std::pair<int64_t, double> seed{0, 0.0};
+      const TreeSnapshot::Entry* entry =
+        snapshot_ ? snapshot_->Find(key) : nullptr;
+      if (entry != nullptr) {
+        seed = {entry->visits, entry->reward};
+      }
+      if (auto it = unsaved_.find(key); it != unsaved_.end()) {
+        seed.first += it->second.visits;
+        seed.second += it->second.reward;
+      }
+      return seed;
+    }
+
+    // Converts a reward between this player's point of view and player
+    // `true`'s, as stored in snapshots. The conversion is its own inverse.
+    double ToPerspective(int64_t visits, double reward) const {
+      return player_id_ ? reward : visits - reward;
+    }
+
+    // Moves what this game's tree added on top of its seeds into unsaved_,
+    // keeping nodes already in the snapshot or unsaved_ and new nodes with
+    // at least kSnapshotMinVisits visits.
+    void AccumulateTree() {
+      for (const auto& [key, node] : tree_) {
+        auto [seed_visits, seed_reward] = Seed(key);
+        if (node.visits <= seed_visits) {
+          continue;
+        }
+        if (seed_visits == 0 && node.visits < kSnapshotMinVisits) {
+          continue;
+        }
+        // Terminal nodes hold their value rather than a sum.
+        double reward = node.is_terminal ? node.reward * node.visits
+                                         : node.reward;
+        TreeSnapshot::Entry& entry = unsaved_[key];
+        entry.key = key;
+        entry.visits += node.visits - seed_visits;
+        entry.reward += ToPerspective(node.visits, reward) - seed_reward;
+      }
+      tree_.clear();
+    }
+
+    // Adds every game played since the last save to the snapshot on disk,
+    // merging with whatever other players saved there in the meantime.
+    void SaveSnapshot() {
+      AccumulateTree();
+      if (unsaved_.empty()) {
+        return;
+      }
+      std::vector<TreeSnapshot::Entry> deltas;
+      deltas.reserve(unsaved_.size());
+      for (const auto& [key, entry] : unsaved_) {
+        deltas.push_back(entry);
+      }
+      if (!TreeSnapshot::Update(kSnapshotPath, deltas)) {
+        std::cerr << "Unable to write snapshot " << kSnapshotPath << "\n";
+      }
+      unsaved_.clear();
+    }
+
+    static double Value(const Node& node) {
+      if (node.is_terminal || node.visits == 0) {
+        return node.reward;
+      }
+      return node.reward / node.visits;
+    }
+
+    void RecordMoveStats(const Turn& turn, const std::vector<int>& valid_moves,
+        int move) {
+      auto chosen = std::find(valid_moves.begin(), valid_moves.end(), move);
+      const Node& child = turn.NextTurns()[chosen - valid_moves.begin()].node_;
+      last_move_stats_ = {static_cast<uint32_t>(std::min<int64_t>(
+                              turn.node_.visits, UINT32_MAX)),
+                          static_cast<float>(Value(child))};
+    }
+
+    void EmitTelemetry(const Turn& turn, const std::vector<int>& valid_moves,
+        int move) {
+      // Approximate per-entry cost of a red-black tree node on top of the
+      // stored key/value pair.
+      constexpr size_t kMapNodeOverhead = 4 * sizeof(void*);
+      size_t node_bytes = 0;
+      for (const auto& [key, node] : tree_) {
+        node_bytes += sizeof(std::pair<const uint64_t, Node>) +
+          kMapNodeOverhead + node.next.capacity() * sizeof(uint64_t);
+      }
+
+      std::vector<SearchTelemetry::Child> children;
+      int i = 0;
+      for (const auto& next_turn : turn.NextTurns()) {
+        const Node& child = next_turn.node_;
+        children.push_back(
+            {valid_moves[i++], child.visits, Value(child), child.is_terminal});
+      }
+      telemetry_.EndMove(name(), move, kNumRollouts, tree_.size(), node_bytes,
+          children);
+    }
+
     const Board* board_;
     bool player_id_;
+    std::unique_ptr<std::random_device> rd_;
     std::mt19937 rand_;
 
     std::map<uint64_t, Node> tree_;
+    std::unique_ptr<TreeSnapshot> snapshot_;
+    // Visits and rewards, from player `true`'s point of view, not yet in
+    // the file at kSnapshotPath.
+    std::map<uint64_t, TreeSnapshot::Entry> unsaved_;
+    SearchTelemetry telemetry_;
+    MoveStats last_move_stats_;
 
   public:
     MonteCarloPlayer(
         std::string_view name, int num_rollouts, double exploration,
+        std::string_view snapshot_path, int snapshot_min_visits,
         std::unique_ptr<std::random_device> rd)
       : Player(name),
         kNumRollouts(num_rollouts),
         kExplorationParameter(exploration),
-        rand_((*rd)()) {}
+        kSnapshotPath(snapshot_path),
+        kSnapshotMinVisits(snapshot_min_visits),
+        rd_(std::move(rd)), rand_(set_seed((*rd_)())) {
+      if (!kSnapshotPath.empty()) {
+        snapshot_ = TreeSnapshot::Open(kSnapshotPath);
+      }
+    }
+
+    ~MonteCarloPlayer() override {
+      if (!kSnapshotPath.empty()) {
+        SaveSnapshot();
+      }
+    }
 };
 
 std::unique_ptr<Player> Player::NewMonteCarlo(std::string_view name,
     int num_rollouts, double exploration,
+    std::string_view snapshot_path, int snapshot_min_visits,
     std::unique_ptr<std::random_device> rd) {
-  return std::unique_ptr<Player>{new MonteCarloPlayer(name, num_rollouts, exploration, std::move(rd))};
+  return std::unique_ptr<Player>{new MonteCarloPlayer(name, num_rollouts, exploration, snapshot_path, snapshot_min_visits, std::move(rd))};
 }
 
@@ -4,6 +4,14 @@
 #include <cctype>
 
 std::unique_ptr<Player> Player::New(std::string_view name_spec) {
+  std::unique_ptr<Player> player = NewFromSpec(name_spec);
+  if (player) {
+    player->spec_ = name_spec;
+  }
+  return player;
+}
+
+std::unique_ptr<Player> Player::NewFromSpec(std::string_view name_spec) {
   if (name_spec.empty()) {
     std::cerr << "Bad player spec <empty>\n";
     return {};
@@ -16,13 +24,27 @@ std::unique_ptr<Player> Player::New(std::string_view name_spec) {
           ? name_spec
           : name_spec.substr(name_spec.find(':') + 1);
 
+  // Numeric arguments follow the type letter, separated by commas,
+  // e.g. "b5,50:Name".
   std::vector<int> args;
   for (size_t idx = 1;
       idx < name_spec.size() && std::isdigit(name_spec[idx]);
       idx++) {
-    args.push_back(std::stoi(std::string{name_spec.substr(idx)}, &idx));
+    size_t length;
+    args.push_back(std::stoi(std::string{name_spec.substr(idx)}, &length));
+    idx += length;
+    if (idx >= name_spec.size() || name_spec[idx] != ',') {
+      break;
+    }
   }
-  
+
+  // An optional "@path" before the name, e.g. "m10000@book.c4t:Name".
+  std::string_view path;
+  size_t at = name_spec.find('@');
+  if (at < name_spec.find(':')) {
+    path = name_spec.substr(at + 1, name_spec.find(':') - at - 1);
+  }
+
   switch (name_spec.front()) {
     case 'h':
       return Player::NewHuman(name.empty() ? "Human" : name);
@@ -33,6 +55,7 @@ std::unique_ptr<Player> Player::New(std::string_view name_spec) {
         /*depth=*/ args.empty() ? 5 : args[0],
         /*sharpness=*/ .9999,
         /*discount=*/ .999,
+        /*eval_scale=*/ args.size() < 2 ? 3.0 : args[1] / 100.0,
         std::make_unique<std::random_device>());
 
     case 'm':
@@ -40,6 +63,8 @@ std::unique_ptr<Player> Player::New(std::string_view name_spec) {
           (name.empty() ? "Monte Carlo" : name),
           /*num_rollouts=*/ args.empty() ? 10000 : args[0],
           /*exploration=*/std::sqrt(2),
+          /*snapshot_path=*/ path,
+          /*snapshot_min_visits=*/ args.size() < 2 ? 32 : args[1],
           std::make_unique<std::random_device>());
 
     default:
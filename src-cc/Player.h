@@ -1,8 +1,10 @@
 #ifndef Player_h_
 #define Player_h_
 
+#include <cinttypes>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
 #include <string_view>
@@ -14,20 +16,38 @@ class Player {
     static std::unique_ptr<Player> NewHuman(std::string_view name);
     static std::unique_ptr<Player> NewBruteForce(
         std::string_view name,
-        int depth, double sharpness, double discount,
+        int depth, double sharpness, double discount, double eval_scale,
         std::unique_ptr<std::random_device> rd);
     static std::unique_ptr<Player> NewMonteCarlo(
         std::string_view name,
         int num_rollouts, double exploration,
+        std::string_view snapshot_path, int snapshot_min_visits,
         std::unique_ptr<std::random_device> rd);
 
     static std::unique_ptr<Player> New(std::string_view name_spec);
 
+    // Search summary for the most recent GetMove() or GetBestMove(), for
+    // players that search.
+    struct MoveStats {
+      uint32_t visits = 0;
+      float value = 0;
+    };
+
     std::string_view name() const { return name_; }
+    std::string_view spec() const { return spec_; }
+    // The RNG seed drawn for the current game, 0 for players without one.
+    uint32_t seed() const { return seed_; }
+
+    bool verbose() const { return verbose_; }
+    void set_verbose(bool verbose) { verbose_ = verbose; }
 
     virtual ~Player() {}
     virtual void StartGame(const Board* board, bool player_id) = 0;
     virtual int GetMove() = 0;
+    // The move the player rates highest, chosen without sampling, for
+    // analysis. Players with no such ranking fall back to GetMove().
+    virtual int GetBestMove() { return GetMove(); }
+    virtual std::optional<MoveStats> last_move_stats() const { return {}; }
 
     Player(const Player&) = delete;
     Player& operator=(const Player&) = delete;
@@ -35,8 +55,15 @@ class Player {
   protected:
     Player(std::string_view name) : name_(name) {}
 
+    uint32_t set_seed(uint32_t seed) { return seed_ = seed; }
+
   private:
+    static std::unique_ptr<Player> NewFromSpec(std::string_view name_spec);
+
     std::string name_;
+    std::string spec_;
+    uint32_t seed_ = 0;
+    bool verbose_ = true;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Player& player) {
@@ -0,0 +1,170 @@
+#include "PositionCache.h"
+
+#include <thread>
+
+#include "Bitboard.h"
+#include "Board.h"
+
+namespace {
+  constexpr uint64_t kPresent = uint64_t{1} << 63;
+
+  uint8_t Columns(uint64_t cells) {
+    uint8_t columns = 0;
+    for (int col = 0; col < Board::kWidth; ++col) {
+      if (cells & Bitboard::Column(col)) {
+        columns |= 1u << col;
+      }
+    }
+    return columns;
+  }
+}
+
+PositionCache& PositionCache::Global() {
+  static PositionCache cache(kDefaultLog2Buckets);
+  return cache;
+}
+
+PositionCache::PositionCache(int log2_buckets)
+  : log2_buckets_(log2_buckets),
+    buckets_(new Bucket[size_t{1} << log2_buckets]) {}
+
+// Layout: valid moves in bits 0-6, winning moves for player false and true
+// in bits 8-14 and 16-22, outcomes for player false and true in bits 24-25
+// and 26-27, and kPresent so an occupied slot is never zero.
+uint64_t PositionCache::Pack(const Entry& entry) {
+  return kPresent | entry.valid_moves |
+    uint64_t{entry.winning_moves[0]} << 8 |
+    uint64_t{entry.winning_moves[1]} << 16 |
+    uint64_t{entry.outcome[0]} << 24 |
+    uint64_t{entry.outcome[1]} << 26;
+}
+
+PositionCache::Entry PositionCache::Unpack(uint64_t data) {
+  Entry entry;
+  entry.valid_moves = data & 0x7f;
+  entry.winning_moves[0] = (data >> 8) & 0x7f;
+  entry.winning_moves[1] = (data >> 16) & 0x7f;
+  entry.outcome[0] = static_cast<Outcome>((data >> 24) & 3);
+  entry.outcome[1] = static_cast<Outcome>((data >> 26) & 3);
+  return entry;
+}
+
+bool PositionCache::IsProven(uint64_t data) {
+  return (data >> 24) & 0xf;
+}
+
+PositionCache::Counters& PositionCache::ThreadCounters() const {
+  static std::atomic<unsigned> next_shard{0};
+  thread_local unsigned shard = next_shard++ % kNumShards;
+  return counters_[shard];
+}
+
+std::optional<PositionCache::Entry> PositionCache::Probe(uint64_t key) const {
+  const Bucket& bucket = buckets_[Hash(key)];
+  bool full = true;
+  for (const Slot& slot : bucket.slots) {
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if (data == 0) {
+      full = false;
+    } else if ((check ^ data) == key) {
+      ThreadCounters().hits.fetch_add(1, std::memory_order_relaxed);
+      return Unpack(data);
+    }
+  }
+  Counters& counters = ThreadCounters();
+  counters.misses.fetch_add(1, std::memory_order_relaxed);
+  if (full) {
+    counters.collisions.fetch_add(1, std::memory_order_relaxed);
+  }
+  return {};
+}
+
+void PositionCache::Store(uint64_t key, const Entry& entry) {
+  uint64_t hash = Hash(key);
+  Bucket& bucket = buckets_[hash];
+
+  // Same position, else an empty slot, else the first unproven slot from a
+  // key-dependent start, else that start slot.
+  int start = key % kSlotsPerBucket;
+  Slot* victim = nullptr;
+  bool evicting = true;
+  for (int i = 0; i < kSlotsPerBucket; ++i) {
+    Slot& slot = bucket.slots[(start + i) % kSlotsPerBucket];
+    uint64_t data = slot.data.load(std::memory_order_relaxed);
+    uint64_t check = slot.check.load(std::memory_order_relaxed);
+    if (data == 0 || (check ^ data) == key) {
+      victim = &slot;
+      evicting = false;
+      break;
+    }
+    if (victim == nullptr && !IsProven(data)) {
+      victim = &slot;
+    }
+  }
+  if (victim == nullptr) {
+    victim = &bucket.slots[start];
+  }
+
+  uint64_t data = Pack(entry);
+  victim->data.store(data, std::memory_order_relaxed);
+  victim->check.store(key ^ data, std::memory_order_relaxed);
+
+  Counters& counters = ThreadCounters();
+  counters.stores.fetch_add(1, std::memory_order_relaxed);
+  if (evicting) {
+    counters.evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+PositionCache::Entry PositionCache::Get(uint64_t key) {
+  if (auto entry = Probe(key)) {
+    return *entry;
+  }
+  Entry entry = Analyze(key);
+  Store(key, entry);
+  return entry;
+}
+
+PositionCache::Entry PositionCache::Analyze(uint64_t key) {
+  uint64_t stones[2] = {Board::Stones(key, false), Board::Stones(key, true)};
+  uint64_t playable = Bitboard::PlayableCells(stones[0] | stones[1]);
+
+  Entry entry;
+  entry.valid_moves = Columns(playable);
+  for (int player = 0; player < 2; ++player) {
+    entry.winning_moves[player] =
+      Columns(Bitboard::WinningCells(stones[player]) & playable);
+  }
+  for (int player = 0; player < 2; ++player) {
+    if (entry.valid_moves == 0) {
+      entry.outcome[player] = kDraw;
+    } else if (entry.winning_moves[player]) {
+      entry.outcome[player] = kWin;
+    } else if (Bitboard::Count(entry.winning_moves[!player]) >= 2) {
+      entry.outcome[player] = kLoss;
+    }
+  }
+  return entry;
+}
+
+PositionCache::Stats PositionCache::stats() const {
+  Stats stats;
+  for (const Counters& counters : counters_) {
+    stats.hits += counters.hits.load(std::memory_order_relaxed);
+    stats.misses += counters.misses.load(std::memory_order_relaxed);
+    stats.collisions += counters.collisions.load(std::memory_order_relaxed);
+    stats.stores += counters.stores.load(std::memory_order_relaxed);
+    stats.evictions += counters.evictions.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+std::ostream& operator<<(std::ostream& os, const PositionCache::Stats& stats) {
+  uint64_t probes = stats.hits + stats.misses;
+  return os << "hits=" << stats.hits << " misses=" << stats.misses
+    << " hit_rate=" << (probes ? 100.0 * stats.hits / probes : 0) << "%"
+    << " collisions=" << stats.collisions
+    << " stores=" << stats.stores
+    << " evictions=" << stats.evictions;
+}
@@ -0,0 +1,103 @@
+#ifndef PositionCache_h_
+#define PositionCache_h_
+
+#include <atomic>
+#include <cinttypes>
+#include <iostream>
+#include <memory>
+#include <optional>
+
+// Fixed-size, lock-free cache of per-position expansion results keyed on
+// Board::Encode(), shared by every player in the process.
+//
+// Each slot holds the key XORed with its data next to the data itself, so a
+// reader that races a writer sees a mismatched pair and treats it as a miss
+// rather than returning another position's data. Slots are grouped into
+// cache-line buckets; a full bucket evicts an entry without a proven outcome
+// before it evicts one with.
+class PositionCache {
+  public:
+    enum Outcome : uint8_t { kUnknown, kWin, kLoss, kDraw };
+
+    // Column bitmaps (bit n = column n) and outcomes, indexed by player.
+    struct Entry {
+      uint8_t valid_moves = 0;
+      uint8_t winning_moves[2] = {0, 0};
+      Outcome outcome[2] = {kUnknown, kUnknown};  // With that player to move.
+
+      bool IsWinningMove(bool player, int column) const {
+        return winning_moves[player] & (1u << column);
+      }
+    };
+
+    struct Stats {
+      uint64_t hits = 0;
+      uint64_t misses = 0;
+      uint64_t collisions = 0;  // Misses on a bucket full of other positions.
+      uint64_t stores = 0;
+      uint64_t evictions = 0;   // Stores that replaced another position.
+    };
+
+    static constexpr int kDefaultLog2Buckets = 16;
+
+    // The process-wide cache, 2^kDefaultLog2Buckets buckets.
+    static PositionCache& Global();
+
+    explicit PositionCache(int log2_buckets);
+
+    std::optional<Entry> Probe(uint64_t key) const;
+    void Store(uint64_t key, const Entry& entry);
+
+    // Probe, falling back to Analyze() and storing the result.
+    Entry Get(uint64_t key);
+
+    // Valid moves, immediate wins for both players and the outcomes they
+    // prove one ply deep: a win for a player with an immediate win, a loss
+    // for a player facing two, and a draw on a full board. Assumes neither
+    // player has already won.
+    static Entry Analyze(uint64_t key);
+
+    Stats stats() const;
+
+    PositionCache(const PositionCache&) = delete;
+    PositionCache& operator=(const PositionCache&) = delete;
+
+  private:
+    static constexpr int kSlotsPerBucket = 4;
+    static constexpr int kNumShards = 16;
+
+    struct Slot {
+      std::atomic<uint64_t> check{0};  // key ^ data
+      std::atomic<uint64_t> data{0};   // 0 when empty
+    };
+    struct alignas(64) Bucket {
+      Slot slots[kSlotsPerBucket];
+    };
+
+    // Counters are sharded by thread so concurrent players do not all
+    // contend on one cache line.
+    struct alignas(64) Counters {
+      std::atomic<uint64_t> hits{0};
+      std::atomic<uint64_t> misses{0};
+      std::atomic<uint64_t> collisions{0};
+      std::atomic<uint64_t> stores{0};
+      std::atomic<uint64_t> evictions{0};
+    };
+
+    static uint64_t Pack(const Entry& entry);
+    static Entry Unpack(uint64_t data);
+    static bool IsProven(uint64_t data);
+
+    uint64_t Hash(uint64_t key) const {
+      return (key * 0x9e3779b97f4a7c15ull) >> (64 - log2_buckets_);
+    }
+    Counters& ThreadCounters() const;
+
+    const int log2_buckets_;
+    std::unique_ptr<Bucket[]> buckets_;
+    mutable Counters counters_[kNumShards];
+};
+
+std::ostream& operator<<(std::ostream& os, const PositionCache::Stats& stats);
+
+#endif
@@ -0,0 +1,179 @@
+#include "SearchTelemetry.h"
+
+#include <mutex>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+  std::ostream* g_sink = nullptr;
+  bool g_hardware_counters = false;
+  std::mutex g_sink_mutex;
+}
+
+void SearchTelemetry::SetSink(std::ostream* sink, bool hardware_counters) {
+  std::lock_guard lock(g_sink_mutex);
+  g_sink = sink;
+  g_hardware_counters = hardware_counters;
+}
+
+#ifndef CONNECT4_NO_TELEMETRY
+
+namespace {
+  double Micros(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  }
+
+  void WriteString(std::ostream& os, std::string_view s) {
+    os << '"';
+    for (char c : s) {
+      if (c == '"' || c == '\\') os << '\\';
+      if (static_cast<unsigned char>(c) < 0x20) continue;
+      os << c;
+    }
+    os << '"';
+  }
+}
+
+// Cycle and instruction counts for the calling thread. Silently unavailable
+// when the kernel refuses perf_event_open (containers, paranoid settings).
+class SearchTelemetry::HardwareCounters {
+  public:
+    HardwareCounters() {
+#ifdef __linux__
+      cycles_fd_ = Open(PERF_COUNT_HW_CPU_CYCLES, -1);
+      if (cycles_fd_ >= 0) {
+        instructions_fd_ = Open(PERF_COUNT_HW_INSTRUCTIONS, cycles_fd_);
+      }
+#endif
+    }
+
+    ~HardwareCounters() {
+#ifdef __linux__
+      if (instructions_fd_ >= 0) close(instructions_fd_);
+      if (cycles_fd_ >= 0) close(cycles_fd_);
+#endif
+    }
+
+    bool ok() const { return cycles_fd_ >= 0 && instructions_fd_ >= 0; }
+
+    void Start() {
+#ifdef __linux__
+      if (!ok()) return;
+      ioctl(cycles_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+      ioctl(cycles_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Returns {cycles, instructions}.
+    std::pair<uint64_t, uint64_t> Stop() {
+#ifdef __linux__
+      if (!ok()) return {0, 0};
+      ioctl(cycles_fd_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      uint64_t values[3] = {};
+      if (read(cycles_fd_, values, sizeof(values)) != sizeof(values)) {
+        return {0, 0};
+      }
+      return {values[1], values[2]};
+#else
+      return {0, 0};
+#endif
+    }
+
+  private:
+#ifdef __linux__
+    static int Open(uint64_t config, int group_fd) {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = config;
+      attr.disabled = group_fd < 0;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+      return syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+    }
+#endif
+
+    int cycles_fd_ = -1;
+    int instructions_fd_ = -1;
+};
+
+SearchTelemetry::SearchTelemetry() {}
+SearchTelemetry::~SearchTelemetry() {}
+
+void SearchTelemetry::BeginMove() {
+  bool hardware_counters;
+  {
+    std::lock_guard lock(g_sink_mutex);
+    active_ = g_sink != nullptr;
+    hardware_counters = g_hardware_counters;
+  }
+  if (!active_) return;
+
+  for (int i = 0; i < kNumPhases; ++i) {
+    times_[i] = Clock::duration::zero();
+    counts_[i] = 0;
+  }
+  rollout_time_ = Clock::duration::zero();
+  max_depth_ = 0;
+  if (hardware_counters && !counters_) {
+    counters_ = std::make_unique<HardwareCounters>();
+  }
+  if (counters_) counters_->Start();
+  move_start_ = Clock::now();
+}
+
+void SearchTelemetry::EndMove(std::string_view player, int move, int rollouts,
+    size_t tree_size, size_t node_bytes,
+    const std::vector<Child>& children) {
+  if (!active_) return;
+  Clock::duration elapsed = Clock::now() - move_start_;
+  auto [cycles, instructions] =
+    counters_ ? counters_->Stop() : std::pair<uint64_t, uint64_t>{0, 0};
+  active_ = false;
+
+  times_[kBackup] = rollout_time_ - times_[kSelect] - times_[kExpand] -
+    times_[kPlayout];
+  double seconds = std::chrono::duration<double>(elapsed).count();
+
+  static constexpr const char* kPhaseNames[kNumPhases] = {
+    "select", "expand", "playout", "backup"};
+
+  std::lock_guard lock(g_sink_mutex);
+  if (g_sink == nullptr) return;
+  std::ostream& os = *g_sink;
+  os << "{\"player\":";
+  WriteString(os, player);
+  os << ",\"move\":" << (move + 1)
+    << ",\"rollouts\":" << rollouts
+    << ",\"elapsed_us\":" << Micros(elapsed)
+    << ",\"playouts_per_sec\":" << (seconds > 0 ? rollouts / seconds : 0)
+    << ",\"tree_size\":" << tree_size
+    << ",\"node_bytes\":" << node_bytes
+    << ",\"max_depth\":" << max_depth_;
+  for (int i = 0; i < kNumPhases; ++i) {
+    os << ",\"" << kPhaseNames[i] << "\":{\"count\":" << counts_[i]
+      << ",\"us\":" << Micros(times_[i]) << '}';
+  }
+  if (counters_ && counters_->ok()) {
+    os << ",\"cycles\":" << cycles << ",\"instructions\":" << instructions;
+  }
+  os << ",\"children\":[";
+  for (size_t i = 0; i < children.size(); ++i) {
+    const Child& child = children[i];
+    os << (i ? "," : "")
+      << "{\"move\":" << (child.move + 1)
+      << ",\"visits\":" << child.visits
+      << ",\"value\":" << child.value
+      << ",\"terminal\":" << (child.is_terminal ? "true" : "false") << '}';
+  }
+  os << "]}\n";
+  os.flush();
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef SearchTelemetry_h_
+#define SearchTelemetry_h_
+
+#include <chrono>
+#include <cinttypes>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Per-move instrumentation for tree search. Each completed move is written
+// as a single JSON line to the sink installed with SetSink(). Building with
+// -DCONNECT4_NO_TELEMETRY compiles every hook down to nothing.
+class SearchTelemetry {
+  public:
+    enum Phase { kSelect, kExpand, kPlayout, kBackup, kNumPhases };
+
+    struct Child {
+      int move;
+      int64_t visits;
+      double value;
+      bool is_terminal;
+    };
+
+    // nullptr disables emission. Hardware counters are only read when
+    // requested and perf_event_open is permitted.
+    static void SetSink(std::ostream* sink, bool hardware_counters = false);
+
+#ifndef CONNECT4_NO_TELEMETRY
+    using Clock = std::chrono::steady_clock;
+
+    class ScopedPhase {
+      public:
+        ScopedPhase(SearchTelemetry* telemetry, Phase phase)
+          : telemetry_(telemetry->active_ ? telemetry : nullptr),
+            phase_(phase) {
+          if (telemetry_) start_ = Clock::now();
+        }
+        ~ScopedPhase() {
+          if (telemetry_) telemetry_->Add(phase_, Clock::now() - start_);
+        }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+      private:
+        SearchTelemetry* telemetry_;
+        Phase phase_;
+        Clock::time_point start_;
+    };
+
+    SearchTelemetry();
+    ~SearchTelemetry();
+
+    bool active() const { return active_; }
+
+    void BeginMove();
+    void EndMove(std::string_view player, int move, int rollouts,
+        size_t tree_size, size_t node_bytes,
+        const std::vector<Child>& children);
+
+    ScopedPhase Time(Phase phase) { return ScopedPhase(this, phase); }
+
+    // Backup is the part of a rollout not spent in any other phase, so it is
+    // derived rather than timed around a handful of additions.
+    void AddRollout(Clock::duration elapsed) {
+      rollout_time_ += elapsed;
+      ++counts_[kBackup];
+    }
+
+    void NoteDepth(int depth) {
+      if (depth > max_depth_) max_depth_ = depth;
+    }
+
+  private:
+    class HardwareCounters;
+
+    void Add(Phase phase, Clock::duration elapsed) {
+      times_[phase] += elapsed;
+      ++counts_[phase];
+    }
+
+    bool active_ = false;
+    Clock::time_point move_start_;
+    Clock::duration rollout_time_{};
+    Clock::duration times_[kNumPhases];
+    uint64_t counts_[kNumPhases];
+    int max_depth_ = 0;
+    std::unique_ptr<HardwareCounters> counters_;
+#else
+    using Clock = std::chrono::steady_clock;
+
+    struct ScopedPhase {
+      ~ScopedPhase() {}
+    };
+
+    bool active() const { return false; }
+
+    void BeginMove() {}
+    void EndMove(std::string_view, int, int, size_t, size_t,
+        const std::vector<Child>&) {}
+
+    ScopedPhase Time(Phase) { return {}; }
+    void AddRollout(Clock::duration) {}
+    void NoteDepth(int) {}
+#endif
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "TreeSnapshot.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::unique_ptr<TreeSnapshot> TreeSnapshot::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    return {};
+  }
+  size_t size = st.st_size;
+  void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return {};
+  }
+
+  const Header* header = static_cast<const Header*>(mapping);
+  if (header->magic != kMagic ||
+      header->num_entries != (size - sizeof(Header)) / sizeof(Entry) ||
+      (size - sizeof(Header)) % sizeof(Entry) != 0) {
+    munmap(mapping, size);
+    return {};
+  }
+  const Entry* entries = reinterpret_cast<const Entry*>(header + 1);
+  return std::unique_ptr<TreeSnapshot>{new TreeSnapshot(
+      mapping, size, {entries, static_cast<size_t>(header->num_entries)})};
+}
+
+TreeSnapshot::~TreeSnapshot() {
+  munmap(mapping_, size_);
+}
+
+bool TreeSnapshot::Write(const std::string& path,
+    std::span<const Entry> entries) {
+  // mkstemp picks a name no other process or thread is writing to.
+  std::string tmp_path = path + ".XXXXXX";
+  int fd = mkstemp(tmp_path.data());
+  if (fd < 0) {
+    return false;
+  }
+  std::FILE* file = fchmod(fd, 0644) == 0 ? fdopen(fd, "wb") : nullptr;
+  if (file == nullptr) {
+    close(fd);
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  Header header{kMagic, 0, entries.size()};
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+    std::fwrite(entries.data(), sizeof(Entry), entries.size(), file) ==
+      entries.size();
+  ok = std::fclose(file) == 0 && ok;
+  if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool TreeSnapshot::Update(const std::string& path,
+    std::span<const Entry> deltas) {
+  std::string lock_path = path + ".lock";
+  int lock_fd = open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (lock_fd < 0) {
+    return false;
+  }
+  if (flock(lock_fd, LOCK_EX) != 0) {
+    close(lock_fd);
+    return false;
+  }
+
+  auto current = Open(path);
+  auto on_disk = current ? current->entries() : std::span<const Entry>{};
+  std::vector<Entry> merged;
+  merged.reserve(on_disk.size() + deltas.size());
+  auto it = on_disk.begin();
+  for (const auto& delta : deltas) {
+    for (; it != on_disk.end() && it->key < delta.key; ++it) {
+      merged.push_back(*it);
+    }
+    if (it != on_disk.end() && it->key == delta.key) {
+      merged.push_back(*it++);
+      merged.back().visits += delta.visits;
+      merged.back().reward += delta.reward;
+    } else {
+      merged.push_back(delta);
+    }
+  }
+  merged.insert(merged.end(), it, on_disk.end());
+
+  bool ok = Write(path, merged);
+  close(lock_fd);
+  return ok;
+}
+
+const TreeSnapshot::Entry* TreeSnapshot::Find(uint64_t key) const {
+  auto it = std::lower_bound(entries_.begin(), entries_.end(), key,
+      [](const Entry& entry, uint64_t key) { return entry.key < key; });
+  if (it == entries_.end() || it->key != key) {
+    return nullptr;
+  }
+  return &*it;
+}
@@ -0,0 +1,69 @@
+#ifndef TreeSnapshot_h_
+#define TreeSnapshot_h_
+
+#include <cinttypes>
+#include <memory>
+#include <span>
+#include <string>
+
+// Read-only, memory-mapped snapshot of Monte Carlo search statistics.
+//
+// The file is a 16-byte header followed by Entry records sorted by key.
+// Children are not stored: they are exactly the positions reachable in one
+// move, so a seeded player re-derives them when it expands the node.
+// Rewards are always from the point of view of player `true`, so one
+// snapshot can seed either side.
+class TreeSnapshot {
+  public:
+    static constexpr uint32_t kMagic = 0x32543443;  // "C4T2"
+
+    struct Header {
+      uint32_t magic;
+      uint32_t reserved;
+      uint64_t num_entries;
+    };
+    static_assert(sizeof(Header) == 16);
+
+    // Opening positions gain kNumRollouts visits per game, so visits are
+    // 64-bit, and `reward`, the sum over all visits, needs double precision
+    // to stay exact past 2^24 half-point rewards. On little-endian machines
+    // this reads "C4T2" files written with 32-bit visits and a zero pad.
+    struct Entry {
+      uint64_t key;
+      uint64_t visits;
+      double reward;
+    };
+    static_assert(sizeof(Entry) == 24);
+
+    // Returns nullptr if `path` does not exist or is not a snapshot.
+    static std::unique_ptr<TreeSnapshot> Open(const std::string& path);
+    ~TreeSnapshot();
+
+    // Writes `entries`, which must be sorted by key without duplicates, to a
+    // temporary file renamed over `path`. Existing mappings of `path` stay
+    // valid. Returns false on I/O failure.
+    static bool Write(const std::string& path, std::span<const Entry> entries);
+
+    // Adds the visits and rewards in `deltas`, sorted by key without
+    // duplicates, to the snapshot at `path`, creating it if needed. The
+    // read-merge-write runs under an flock() on "<path>.lock", so concurrent
+    // updaters, in this process or others, do not lose each other's work.
+    // Plain Write() calls do not take the lock.
+    static bool Update(const std::string& path, std::span<const Entry> deltas);
+
+    const Entry* Find(uint64_t key) const;
+    std::span<const Entry> entries() const { return entries_; }
+
+    TreeSnapshot(const TreeSnapshot&) = delete;
+    TreeSnapshot& operator=(const TreeSnapshot&) = delete;
+
+  private:
+    TreeSnapshot(void* mapping, size_t size, std::span<const Entry> entries)
+      : mapping_(mapping), size_(size), entries_(entries) {}
+
+    void* mapping_;
+    size_t size_;
+    std::span<const Entry> entries_;
+};
+
+#endif
@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Bitboard.h"
+#include "Board.h"
+#include "Player.h"
+#include "PositionCache.h"
+
+// Evaluates a stream of positions, one per line, on a pool of worker
+// threads and writes one result line per input line, in input order.
+//
+// A position is either an encoded board ("0x" followed by the hex value of
+// Board::Encode()) or a string of moves from the empty board, columns 1-7,
+// e.g. "4453". The side to move follows from the number of stones, with
+// player `true` moving first as in Game.
+//
+// Output columns, tab separated: input, encoded position, side to move,
+// best move, its value, visits (rollouts for Monte Carlo, nodes for brute
+// force) and any outcome proven by the position cache.
+
+namespace {
+  struct Result {
+    uint64_t key = 0;
+    bool mover = true;
+    int move = -1;
+    Player::MoveStats stats;
+    PositionCache::Outcome outcome = PositionCache::kUnknown;
+    std::string error;
+    bool done = false;
+  };
+
+  struct Job {
+    std::string input;
+    std::shared_ptr<Result> result;
+  };
+
+  // Parses a line into an encoded position, or returns an error message.
+  std::string Parse(std::string_view line, uint64_t* key) {
+    if (line.empty()) {
+      return "empty line";
+    }
+    if (line.starts_with("0x")) {
+      try {
+        size_t length;
+        *key = std::stoull(std::string{line.substr(2)}, &length, 16);
+        if (length + 2 != line.size()) {
+          return "bad encoded position";
+        }
+      } catch (const std::exception&) {
+        return "bad encoded position";
+      }
+      // One byte per column, stones below a marker bit at the column's
+      // height; the eighth byte is an empty spare column.
+      for (int column = 0; column < 8; column++) {
+        unsigned byte = (*key >> (8 * column)) & 0xff;
+        if (byte == 0 || byte >= (2u << Board::kHeight) ||
+            (column == Board::kWidth && byte != 1)) {
+          return "bad encoded position";
+        }
+      }
+      // Player `true` moves first, so has as many stones or one more.
+      uint64_t first = Board::Stones(*key, true);
+      uint64_t second = Board::Stones(*key, false);
+      int surplus = Bitboard::Count(first) - Bitboard::Count(second);
+      if (surplus != 0 && surplus != 1) {
+        return "unreachable position";
+      }
+      if (Bitboard::HasFour(first) || Bitboard::HasFour(second)) {
+        return "game already won";
+      }
+      return {};
+    }
+
+    auto board = Board::New();
+    bool player = true;
+    for (char c : line) {
+      int column = c - '1';
+      if (!board->IsValidMove(column)) {
+        return "invalid move";
+      }
+      if (board->PlayStone(player, column)) {
+        return "game already won";
+      }
+      player = !player;
+    }
+    *key = board->Encode();
+    return {};
+  }
+
+  const char* OutcomeName(PositionCache::Outcome outcome) {
+    switch (outcome) {
+      case PositionCache::kWin: return "win";
+      case PositionCache::kLoss: return "loss";
+      case PositionCache::kDraw: return "draw";
+      default: return "-";
+    }
+  }
+
+  class WorkerPool {
+    public:
+      WorkerPool(std::string_view engine, int num_threads) {
+        for (int i = 0; i < num_threads; i++) {
+          threads_.emplace_back([this, engine] { Run(engine); });
+        }
+      }
+
+      ~WorkerPool() {
+        {
+          std::lock_guard lock(mutex_);
+          stopping_ = true;
+        }
+        work_ready_.notify_all();
+        for (auto& thread : threads_) {
+          thread.join();
+        }
+      }
+
+      void Submit(std::shared_ptr<Result> result) {
+        {
+          std::lock_guard lock(mutex_);
+          queue_.push_back(std::move(result));
+        }
+        work_ready_.notify_one();
+      }
+
+      void Wait(const Result& result) {
+        std::unique_lock lock(mutex_);
+        result_ready_.wait(lock, [&] { return result.done; });
+      }
+
+    private:
+      void Run(std::string_view engine) {
+        auto player = Player::New(engine);
+        if (player) {
+          player->set_verbose(false);
+        }
+        while (true) {
+          std::shared_ptr<Result> result;
+          {
+            std::unique_lock lock(mutex_);
+            work_ready_.wait(lock, [&] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) {
+              return;
+            }
+            result = std::move(queue_.front());
+            queue_.pop_front();
+          }
+
+          Evaluate(player.get(), *result);
+
+          {
+            std::lock_guard lock(mutex_);
+            result->done = true;
+          }
+          result_ready_.notify_all();
+        }
+      }
+
+      static void Evaluate(Player* player, Result& result) {
+        if (player == nullptr) {
+          result.error = "bad engine spec";
+          return;
+        }
+        auto entry = PositionCache::Global().Get(result.key);
+        result.outcome = entry.outcome[result.mover];
+        if (entry.valid_moves == 0) {
+          result.error = "no valid moves";
+          return;
+        }
+        auto board = Board::New(result.key);
+        try {
+          player->StartGame(board.get(), result.mover);
+          result.move = player->GetBestMove();
+          result.stats = player->last_move_stats().value_or(Player::MoveStats{});
+        } catch (const std::exception& e) {
+          result.error = e.what();
+        }
+      }
+
+      std::mutex mutex_;
+      std::condition_variable work_ready_;
+      std::condition_variable result_ready_;
+      std::deque<std::shared_ptr<Result>> queue_;
+      bool stopping_ = false;
+      std::vector<std::thread> threads_;
+  };
+
+  void Write(std::ostream& os, const Job& job) {
+    const Result& result = *job.result;
+    os << job.input << '\t';
+    if (!result.error.empty() && result.key == 0) {
+      os << "error: " << result.error << '\n';
+      return;
+    }
+    os << "0x" << std::hex << result.key << std::dec << '\t'
+      << (result.mover ? 'x' : 'o') << '\t';
+    if (!result.error.empty()) {
+      os << "error: " << result.error << '\n';
+      return;
+    }
+    os << (result.move + 1) << '\t'
+      << result.stats.value << '\t'
+      << result.stats.visits << '\t'
+      << OutcomeName(result.outcome) << '\n';
+  }
+
+  int Usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " [options] [file]\n";
+    std::cerr << "reads positions from file, or stdin if omitted or -\n";
+    std::cerr << "options\n";
+    std::cerr << "  --engine=SPEC  Monte Carlo or brute force player spec, e.g.\n";
+    std::cerr << "                 m10000 or b5 (default m10000)\n";
+    std::cerr << "  --threads=N    worker threads (default: hardware concurrency)\n";
+    std::cerr << "  --window=N     max lines read ahead of output (default 4096)\n";
+    std::cerr << "  --dedup=N      remember N positions for deduplication (default\n";
+    std::cerr << "                 1048576, 0 disables)\n";
+    return 1;
+  }
+}
+
+int main(int argc, const char* argv[]) {
+  std::string engine = "m10000";
+  int num_threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t window = 4096;
+  size_t dedup_capacity = 1 << 20;
+  std::string path = "-";
+  try {
+    for (int i = 1; i < argc; i++) {
+      std::string_view arg = argv[i];
+      std::string value{arg.substr(arg.find('=') + 1)};
+      if (arg.starts_with("--engine=")) {
+        engine = value;
+      } else if (arg.starts_with("--threads=")) {
+        num_threads = std::max(1, std::stoi(value));
+      } else if (arg.starts_with("--window=")) {
+        window = std::max<size_t>(1, std::stoul(value));
+      } else if (arg.starts_with("--dedup=")) {
+        dedup_capacity = std::stoul(value);
+      } else if (arg.starts_with("--") || i != argc - 1) {
+        return Usage(argv[0]);
+      } else {
+        path = arg;
+      }
+    }
+
+    // Only searching players can analyse positions unattended.
+    if (!engine.starts_with('m') && !engine.starts_with('b')) {
+      return Usage(argv[0]);
+    }
+    if (Player::New(engine) == nullptr) {
+      return Usage(argv[0]);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return Usage(argv[0]);
+  }
+
+  std::ifstream file;
+  if (path != "-") {
+    file.open(path);
+    if (!file) {
+      std::cerr << "Unable to open " << path << "\n";
+      return 1;
+    }
+  }
+  std::istream& in = path == "-" ? std::cin : file;
+  std::ios::sync_with_stdio(false);
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t num_positions = 0;
+  uint64_t num_evaluated = 0;
+  {
+    WorkerPool pool(engine, num_threads);
+
+    // Lines read but not yet written, in input order. Bounding this is the
+    // back-pressure: reading stalls until the oldest result is written.
+    std::deque<Job> pending;
+    // Recently seen positions, evicted first-in first-out.
+    std::unordered_map<uint64_t, std::shared_ptr<Result>> seen;
+    std::deque<uint64_t> seen_order;
+
+    auto write_oldest = [&] {
+      pool.Wait(*pending.front().result);
+      Write(std::cout, pending.front());
+      pending.pop_front();
+    };
+
+    std::string line;
+    while (std::getline(in, line)) {
+      if (!line.empty() && line.back() == '\r') {
+        line.pop_back();
+      }
+      ++num_positions;
+      if (pending.size() >= window) {
+        write_oldest();
+      }
+
+      uint64_t key = 0;
+      std::string error = Parse(line, &key);
+      if (!error.empty()) {
+        auto result = std::make_shared<Result>();
+        result->error = error;
+        result->done = true;
+        pending.push_back({line, result});
+        continue;
+      }
+
+      if (auto it = seen.find(key); it != seen.end()) {
+        pending.push_back({line, it->second});
+        continue;
+      }
+
+      auto result = std::make_shared<Result>();
+      result->key = key;
+      uint64_t stones = Board::Stones(key, true) | Board::Stones(key, false);
+      result->mover = Bitboard::Count(stones) % 2 == 0;
+      pending.push_back({line, result});
+      pool.Submit(result);
+      ++num_evaluated;
+
+      if (dedup_capacity > 0) {
+        if (seen.size() >= dedup_capacity) {
+          seen.erase(seen_order.front());
+          seen_order.pop_front();
+        }
+        seen.emplace(key, result);
+        seen_order.push_back(key);
+      }
+    }
+    while (!pending.empty()) {
+      write_oldest();
+    }
+  }
+  std::cout.flush();
+
+  double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  std::cerr << num_positions << " positions (" << num_evaluated
+    << " evaluated) in " << seconds << "s, "
+    << (seconds > 0 ? num_positions / seconds : 0) << " positions/sec\n";
+  std::cerr << "position cache: " << PositionCache::Global().stats() << "\n";
+}
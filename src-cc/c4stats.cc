@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Board.h"
+#include "GameRecord.h"
+
+// Aggregate statistics over binary game records written by `connect4
+// --record=FILE`.
+
+namespace {
+  // Outcome counts indexed by GameRecord::Result.
+  using Outcomes = std::array<uint64_t, 3>;
+
+  void PrintOutcomes(std::ostream& os, const Outcomes& outcomes) {
+    uint64_t total = outcomes[0] + outcomes[1] + outcomes[2];
+    auto percent = [&](uint64_t n) {
+      return total == 0 ? 0.0 : 100.0 * n / total;
+    };
+    os << std::setw(10) << total
+      << std::fixed << std::setprecision(1)
+      << "  first " << std::setw(5) << percent(outcomes[GameRecord::kFirstPlayerWins]) << "%"
+      << "  second " << std::setw(5) << percent(outcomes[GameRecord::kSecondPlayerWins]) << "%"
+      << "  draw " << std::setw(5) << percent(outcomes[GameRecord::kDraw]) << "%";
+  }
+}
+
+int main(int argc, const char* argv[]) {
+  int max_ply = 8;
+  size_t top = 20;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--max-ply=")) {
+      max_ply = std::stoi(std::string{arg.substr(arg.find('=') + 1)});
+    } else if (arg.starts_with("--top=")) {
+      top = std::stoul(std::string{arg.substr(arg.find('=') + 1)});
+    } else if (arg.starts_with("--")) {
+      files.clear();
+      break;
+    } else {
+      files.emplace_back(arg);
+    }
+  }
+  if (files.empty()) {
+    std::cerr << "usage: " << argv[0] << " [options] <record file>...\n";
+    std::cerr << "options\n";
+    std::cerr << "  --max-ply=N  track positions for the first N plies (default 8)\n";
+    std::cerr << "  --top=K      list the K most frequent positions (default 20)\n";
+    return 1;
+  }
+
+  Outcomes overall{};
+  std::array<Outcomes, Board::kWidth> by_first_move{};
+  std::map<int, uint64_t> lengths;
+  std::unordered_map<uint64_t, Outcomes> positions;
+
+  for (const auto& file : files) {
+    auto reader = GameRecordReader::Open(file);
+    if (reader == nullptr) {
+      std::cerr << "Unable to open " << file << "\n";
+      return 1;
+    }
+    for (GameRecordView record : *reader) {
+      auto result = record.result();
+      auto moves = record.moves();
+      overall[result]++;
+      lengths[moves.size()]++;
+      if (moves.empty()) {
+        continue;
+      }
+      if (moves[0] < Board::kWidth) {
+        by_first_move[moves[0]][result]++;
+      }
+
+      auto board = Board::New();
+      positions[board->Encode()][result]++;
+      int plies = std::min<int>(moves.size(), max_ply);
+      for (int ply = 0; ply < plies; ply++) {
+        board->PlayStone(ply % 2 == 0, moves[ply]);
+        positions[board->Encode()][result]++;
+      }
+    }
+    if (reader->valid_size() != reader->size()) {
+      std::cerr << file << ": ignored " << (reader->size() - reader->valid_size())
+        << " trailing bytes\n";
+    }
+  }
+
+  std::cout << "games";
+  PrintOutcomes(std::cout, overall);
+  std::cout << "\n\nfirst move\n";
+  for (int column = 0; column < Board::kWidth; column++) {
+    std::cout << "  " << (column + 1);
+    PrintOutcomes(std::cout, by_first_move[column]);
+    std::cout << "\n";
+  }
+
+  std::cout << "\ngame length\n";
+  for (const auto& [length, count] : lengths) {
+    std::cout << "  " << std::setw(2) << length << std::setw(10) << count << "\n";
+  }
+
+  std::vector<std::pair<uint64_t, Outcomes>> ranked(
+      positions.begin(), positions.end());
+  auto total = [](const Outcomes& o) { return o[0] + o[1] + o[2]; };
+  top = std::min(top, ranked.size());
+  std::partial_sort(ranked.begin(), ranked.begin() + top, ranked.end(),
+      [&](const auto& a, const auto& b) {
+        return total(a.second) > total(b.second);
+      });
+  std::cout << "\npositions (first " << max_ply << " plies, "
+    << positions.size() << " distinct)\n";
+  for (size_t i = 0; i < top; i++) {
+    std::cout << "  0x" << std::hex << std::setfill('0') << std::setw(16)
+      << ranked[i].first << std::dec << std::setfill(' ');
+    PrintOutcomes(std::cout, ranked[i].second);
+    std::cout << "\n";
+  }
+}
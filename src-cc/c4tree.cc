@@ -0,0 +1,129 @@
+#include <cinttypes>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "Board.h"
+#include "TreeSnapshot.h"
+
+// Inspects and merges Monte Carlo tree snapshots written by players with an
+// "@path" spec, e.g. `connect4 m10000@book.c4t b5`.
+
+namespace {
+  int Usage(const char* argv0) {
+    std::cerr << "usage: " << argv0 << " info <snapshot>\n";
+    std::cerr << "       " << argv0
+      << " merge [--min-visits=N] <output> <snapshot>...\n";
+    std::cerr << "merge sums the visits and rewards of every position, so\n";
+    std::cerr << "inputs should come from independent runs rather than from\n";
+    std::cerr << "players seeded with each other's snapshots.\n";
+    return 1;
+  }
+
+  int Info(const std::string& path) {
+    auto snapshot = TreeSnapshot::Open(path);
+    if (snapshot == nullptr) {
+      std::cerr << "Unable to open " << path << "\n";
+      return 1;
+    }
+    auto entries = snapshot->entries();
+    uint64_t total_visits = 0;
+    for (const auto& entry : entries) {
+      total_visits += entry.visits;
+    }
+    std::cout << "positions: " << entries.size() << "\n";
+    std::cout << "visits: " << total_visits << "\n";
+    if (const auto* root = snapshot->Find(Board::New()->Encode())) {
+      std::cout << "opening: " << root->visits << " visits, "
+        << (root->visits ? root->reward / root->visits : 0)
+        << " first player value\n";
+    }
+    return 0;
+  }
+
+  int Merge(const std::string& output, const std::vector<std::string>& inputs,
+      uint64_t min_visits) {
+    std::vector<std::unique_ptr<TreeSnapshot>> snapshots;
+    for (const auto& input : inputs) {
+      snapshots.push_back(TreeSnapshot::Open(input));
+      if (snapshots.back() == nullptr) {
+        std::cerr << "Unable to open " << input << "\n";
+        return 1;
+      }
+    }
+
+    // k-way merge of the sorted inputs: (key, input index, entry index).
+    using Cursor = std::tuple<uint64_t, size_t, size_t>;
+    std::priority_queue<Cursor, std::vector<Cursor>, std::greater<>> heads;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+      if (!snapshots[i]->entries().empty()) {
+        heads.emplace(snapshots[i]->entries()[0].key, i, 0);
+      }
+    }
+
+    std::vector<TreeSnapshot::Entry> merged;
+    while (!heads.empty()) {
+      auto [key, input, index] = heads.top();
+      heads.pop();
+      const auto& entry = snapshots[input]->entries()[index];
+      if (!merged.empty() && merged.back().key == key) {
+        merged.back().visits += entry.visits;
+        merged.back().reward += entry.reward;
+      } else {
+        if (!merged.empty() && merged.back().visits < min_visits) {
+          merged.pop_back();
+        }
+        merged.push_back(entry);
+      }
+      if (++index < snapshots[input]->entries().size()) {
+        heads.emplace(snapshots[input]->entries()[index].key, input, index);
+      }
+    }
+    if (!merged.empty() && merged.back().visits < min_visits) {
+      merged.pop_back();
+    }
+
+    // Inputs stay mapped until here, so the output may be one of them.
+    if (!TreeSnapshot::Write(output, merged)) {
+      std::cerr << "Unable to write " << output << "\n";
+      return 1;
+    }
+    std::cout << "merged " << inputs.size() << " snapshots, "
+      << merged.size() << " positions\n";
+    return 0;
+  }
+}
+
+int main(int argc, const char* argv[]) {
+  if (argc < 3) {
+    return Usage(argv[0]);
+  }
+  std::string_view command = argv[1];
+  if (command == "info" && argc == 3) {
+    return Info(argv[2]);
+  }
+  if (command != "merge") {
+    return Usage(argv[0]);
+  }
+
+  uint64_t min_visits = 0;
+  std::vector<std::string> paths;
+  for (int i = 2; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--min-visits=")) {
+      min_visits = std::stoull(std::string{arg.substr(arg.find('=') + 1)});
+    } else {
+      paths.emplace_back(arg);
+    }
+  }
+  if (paths.size() < 2) {
+    return Usage(argv[0]);
+  }
+  return Merge(paths[0], {paths.begin() + 1, paths.end()}, min_visits);
+}
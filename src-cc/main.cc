@@ -1,11 +1,17 @@
 #include <cmath>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <random>
+#include <string_view>
+#include <vector>
 
 #include "Board.h"
 #include "Player.h"
 #include "Game.h"
+#include "GameRecord.h"
+#include "PositionCache.h"
+#include "SearchTelemetry.h"
 
 int main(int argc, const char* argv[]) {
   std::unique_ptr<Board> b = Board::New();
@@ -13,13 +19,59 @@ int main(int argc, const char* argv[]) {
   std::unique_ptr<Player> players[2];
   std::string player_names[2] = {"h:Human", "m:Monte Carlo"};
 
-  if (argc == 3) {
-    player_names[0] = argv[1];
-    player_names[1] = argv[2];
-  } else if (argc > 1) {
-    std::cerr << "usage: " << argv[0] << " <player> <player>\n";
+  std::vector<std::string_view> positional;
+  std::ofstream telemetry_file;
+  bool perf_counters = false;
+  std::unique_ptr<GameRecordWriter> recorder;
+  int num_games = 1;
+  bool quiet = false;
+  bool cache_stats = false;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg = argv[i];
+    if (arg.starts_with("--telemetry=")) {
+      telemetry_file.open(std::string{arg.substr(arg.find('=') + 1)});
+      if (!telemetry_file) {
+        std::cerr << "Unable to open " << arg << "\n";
+        exit(1);
+      }
+    } else if (arg == "--perf-counters") {
+      perf_counters = true;
+    } else if (arg.starts_with("--record=")) {
+      recorder = GameRecordWriter::Open(
+          std::string{arg.substr(arg.find('=') + 1)});
+      if (recorder == nullptr) {
+        std::cerr << "Unable to open " << arg << "\n";
+        exit(1);
+      }
+    } else if (arg.starts_with("--games=")) {
+      num_games = std::stoi(std::string{arg.substr(arg.find('=') + 1)});
+    } else if (arg == "--quiet") {
+      quiet = true;
+    } else if (arg == "--cache-stats") {
+      cache_stats = true;
+    } else {
+      positional.push_back(arg);
+    }
+  }
+
+  if (positional.size() == 2) {
+    player_names[0] = positional[0];
+    player_names[1] = positional[1];
+  } else if (!positional.empty()) {
+    std::cerr << "usage: " << argv[0] << " [options] <player> <player>\n";
     std::cerr << "where\n";
     std::cerr << "  player is a string [hbm]:...\n";
+    std::cerr << "options\n";
+    std::cerr << "  --telemetry=FILE  per-move search stats as JSON lines\n";
+    std::cerr << "  --perf-counters   include hardware counters in telemetry\n";
+    std::cerr << "  --record=FILE     append binary game records to FILE\n";
+    std::cerr << "  --games=N         play N games in a row\n";
+    std::cerr << "  --quiet           only print the final tally\n";
+    std::cerr << "  --cache-stats     report position cache counters\n";
+  }
+
+  if (telemetry_file.is_open()) {
+    SearchTelemetry::SetSink(&telemetry_file, perf_counters);
   }
 
   for (int i = 0; i < 2; i++) {
@@ -28,15 +80,36 @@ int main(int argc, const char* argv[]) {
       std::cerr << "Unable to initialize player\n";
       exit(1);
     }
+    players[i]->set_verbose(!quiet);
   }
 
-  Game g(players[0].get(), players[1].get());
-  Player* result = g.Play();
+  int wins[2] = {0, 0};
+  for (int game = 0; game < num_games; game++) {
+    Game g(players[0].get(), players[1].get());
+    g.set_recorder(recorder.get());
+    g.set_verbose(!quiet);
+    Player* result = g.Play();
+    if (result != nullptr) {
+      wins[result == players[0].get() ? 0 : 1]++;
+    }
 
-  std::cout << g << "\n\n";
-  if (result == nullptr) {
-    std::cout << "DRAW!\n";
-  } else {
-    std::cout << *result << " WINS!!!\n";
+    if (!quiet) {
+      std::cout << g << "\n\n";
+      if (result == nullptr) {
+        std::cout << "DRAW!\n";
+      } else {
+        std::cout << *result << " WINS!!!\n";
+      }
+    }
+  }
+
+  if (num_games > 1 || quiet) {
+    std::cout << *players[0] << ": " << wins[0] << ", "
+      << *players[1] << ": " << wins[1] << ", "
+      << "draws: " << (num_games - wins[0] - wins[1]) << "\n";
+  }
+  if (cache_stats) {
+    std::cout << "position cache: " << PositionCache::Global().stats() << "\n";
   }
+  SearchTelemetry::SetSink(nullptr);
 }